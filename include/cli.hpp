@@ -1,16 +1,28 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <iostream>
 #include <string>
 #include <vector>
 
+#include "schedule.hpp"
+
 struct CLIOptions {
     std::filesystem::path sourcePath;
     std::filesystem::path destinationPath;
     bool dryRun = false;
     bool mirror = false;
     bool showTime = false;
+    // Keep a checkpoint journal in the destination so interrupted syncs can resume.
+    bool resume = false;
+    // Files larger than this are copied in chunks of this size, with each chunk
+    // journaled when resume is enabled.
+    std::uintmax_t resumeChunkSize = 8 * 1024 * 1024;
+    // Order in which copies are issued, and how many pending copies are
+    // collected and reordered at a time.
+    SchedulePolicy schedule = SchedulePolicy::Traversal;
+    std::size_t scheduleWindow = 1024;
     std::vector<std::string> excludePatterns;
     std::vector<std::string> includePatterns;
 };
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+// Checkpoint journal stored in the destination root. It records files that
+// finished copying and the last verified chunk of large files still in flight,
+// so an interrupted sync can skip completed work and continue partial files.
+//
+// The journal is an append-only text file, one record per line:
+//   D <size> <mtime> <path>
+//   P <size> <mtime> <offset> <chunkLength> <path>
+// Later records for the same path replace earlier ones. Records are buffered
+// and appended in batches so journaling does not become a per-file write.
+class SyncJournal {
+public:
+    struct Entry {
+        bool done = false;
+        std::uintmax_t size = 0;
+        std::int64_t mtime = 0;
+        // Partial copies only: bytes [0, offset) are on disk, and the last
+        // chunkLength bytes before offset are re-checked against the source
+        // before resuming.
+        std::uintmax_t offset = 0;
+        std::uintmax_t chunkLength = 0;
+    };
+
+    static constexpr const char* kFileName = ".synccli-journal";
+
+    explicit SyncJournal(const std::filesystem::path& destinationRoot, std::size_t batchSize = 256);
+    ~SyncJournal();
+
+    SyncJournal(const SyncJournal&) = delete;
+    SyncJournal& operator=(const SyncJournal&) = delete;
+
+    // Reads an existing journal, if any. Incomplete trailing records from an
+    // interrupted write are ignored. Returns false on read errors.
+    bool load(std::ostream& err);
+
+    // Returns the latest record for the relative path, or nullptr.
+    const Entry* find(const std::string& relativePath) const;
+
+    // Queue records; a batch is flushed once enough records are pending or
+    // enough time has passed. Return false if an automatic flush failed.
+    bool recordDone(const std::string& relativePath, std::uintmax_t size, std::int64_t mtime);
+    bool recordProgress(const std::string& relativePath, std::uintmax_t size, std::int64_t mtime,
+                        std::uintmax_t offset, std::uintmax_t chunkLength);
+
+    // True if queuing one more record would flush the batch. Callers whose
+    // records describe unsynced data use this to sync it before recording.
+    bool flushDue() const;
+
+    // Append all pending records to the journal file and sync it to disk.
+    // Returns false on error.
+    bool flush();
+
+    // Delete the journal file once a sync completed successfully.
+    bool remove(std::ostream& err);
+
+    const std::filesystem::path& path() const { return journalPath; }
+
+private:
+    bool queue(const std::string& relativePath, const Entry& entry);
+
+    std::filesystem::path journalPath;
+    std::size_t batchSize;
+    std::unordered_map<std::string, Entry> entries;
+    std::map<std::string, Entry> pending;
+    std::ofstream stream;
+    std::chrono::steady_clock::time_point lastFlush;
+};
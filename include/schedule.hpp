@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Order in which pending copies are issued. Everything other than Traversal
+// collects copies into bounded windows and reorders each window before copying.
+enum class SchedulePolicy {
+    Traversal,   // directory-iteration order, copies issued immediately
+    Inode,       // ascending source inode number
+    Extent,      // ascending physical offset of the first extent (FIEMAP), falling back to inode
+    SmallFirst,  // smallest files first for early progress
+    LargeFirst,  // largest files first to shorten the tail
+};
+
+// Parses a policy name ("traversal", "inode", "extent", "small-first",
+// "large-first"). Returns false for unknown names.
+bool parseSchedulePolicy(const std::string& name, SchedulePolicy& policy);
+
+const char* schedulePolicyName(SchedulePolicy policy);
+
+struct PendingCopy {
+    std::filesystem::path source;
+    std::filesystem::path destination;
+    std::string relativePath;
+    std::uintmax_t size = 0;
+    bool sizeKnown = false;
+    std::int64_t mtime = 0;
+    bool isOverwrite = false;
+    std::uintmax_t resumeOffset = 0;
+    // Physical placement key on the source device; see sourceLocality().
+    // Extent offsets and inode numbers are different units, so copies with
+    // an extent key are ordered as a separate group after those without.
+    std::uint64_t locality = 0;
+    bool hasExtent = false;
+};
+
+// Returns a key that approximates where the file lives on disk: the physical
+// offset of its first extent for Extent (if the filesystem reports one, in
+// which case hasExtent is set), and the inode number otherwise. Returns 0
+// when neither is available.
+std::uint64_t sourceLocality(const std::filesystem::path& p, SchedulePolicy policy, bool& hasExtent);
+
+// Sorts a window of pending copies according to the policy. Locality orders
+// by (hasExtent, locality); size-aware policies break ties the same way, and
+// Traversal leaves the window untouched.
+void orderPendingCopies(std::vector<PendingCopy>& window, SchedulePolicy policy);
+
+// Asks the kernel to start reading up to length bytes of the file from offset
+// ahead of the copy. A no-op where readahead hints are unsupported.
+void adviseWillNeed(const std::filesystem::path& p, std::uintmax_t offset, std::uintmax_t length);
@@ -0,0 +1,36 @@
+#!/usr/bin/env bash
+# Compare copy schedule policies on a fresh copy of the same source tree.
+#
+# Usage: scripts/bench_schedule.sh [source-dir] [scratch-dir] [synccli-binary]
+#
+# Without a source directory, a mixed-size dataset is generated under the
+# scratch directory. Run as root to drop the page cache before each policy,
+# otherwise later runs may read the source from memory instead of disk.
+set -euo pipefail
+
+SCRATCH="${2:-/tmp/synccli_schedule_bench}"
+SRC="${1:-$SCRATCH/source}"
+SYNCCLI="${3:-./build/synccli}"
+POLICIES="${POLICIES:-traversal inode extent small-first large-first}"
+WINDOW="${WINDOW:-1024}"
+
+if [[ -z "${1:-}" && ! -d "$SRC" ]]; then
+    echo "Generating dataset in $SRC"
+    for d in $(seq 1 20); do
+        mkdir -p "$SRC/dir_$d"
+        for f in $(seq 1 50); do
+            head -c $(( (RANDOM % 512 + 1) * 1024 )) /dev/urandom > "$SRC/dir_$d/file_$f.bin"
+        done
+    done
+fi
+
+for policy in $POLICIES; do
+    dst="$SCRATCH/dst_$policy"
+    rm -rf "$dst"
+    sync
+    if [[ $EUID -eq 0 ]]; then
+        echo 3 > /proc/sys/vm/drop_caches
+    fi
+    printf '%-12s ' "$policy"
+    "$SYNCCLI" -s "$SRC" -d "$dst" --schedule "$policy" --schedule-window "$WINDOW" --time | grep '^\[TIMING\]'
+done
@@ -1,6 +1,7 @@
 #include "cli.hpp"
 
 #include <algorithm>
+#include <stdexcept>
 
 namespace {
 
@@ -10,6 +11,16 @@ bool consumeOptionWithValue(int& i, int argc, char** argv, std::string& outValue
     return true;
 }
 
+bool parsePositiveCount(const std::string& value, std::size_t& outCount) {
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) return false;
+    try {
+        outCount = static_cast<std::size_t>(std::stoull(value));
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+    return outCount > 0;
+}
+
 }
 
 void printUsage(std::ostream& out) {
@@ -17,7 +28,8 @@ void printUsage(std::ostream& out) {
     out << "\n";
     out << "Usage:\n";
     out << "  synccli -s <source> -d <destination> [--dry-run] [--mirror]\n";
-    out << "          [--exclude <pattern>]... [--include <pattern>]... [--time]\n";
+    out << "          [--exclude <pattern>]... [--include <pattern>]... [--time] [--resume]\n";
+    out << "          [--schedule <policy>] [--schedule-window <n>]\n";
     out << "\n";
     out << "Options:\n";
     out << "  -s, --source <path>        Source directory\n";
@@ -28,6 +40,12 @@ void printUsage(std::ostream& out) {
     out << "      --include <pattern>    Glob pattern to include (can be repeated). If any includes are set, only\n";
     out << "                             matching paths are considered (before applying excludes).\n";
     out << "      --time                 Print timing and throughput summary\n";
+    out << "      --resume               Journal progress in the destination; a rerun skips finished files and\n";
+    out << "                             continues large files from the last verified chunk\n";
+    out << "      --schedule <policy>    Copy order: traversal (default), inode, extent, small-first, large-first.\n";
+    out << "                             Non-traversal policies reorder pending copies in windows and issue\n";
+    out << "                             readahead hints; inode/extent reduce seeking on spinning disks\n";
+    out << "      --schedule-window <n>  Pending copies collected per reordered window (default 1024)\n";
     out << "      --help                 Show this help\n";
 }
 
@@ -59,6 +77,28 @@ bool parseCLI(int argc, char** argv, CLIOptions& options, std::ostream& out, std
             options.mirror = true;
         } else if (arg == "--time") {
             options.showTime = true;
+        } else if (arg == "--resume") {
+            options.resume = true;
+        } else if (arg == "--schedule") {
+            std::string value;
+            if (!consumeOptionWithValue(i, argc, argv, value)) {
+                err << "Missing value for --schedule\n";
+                return false;
+            }
+            if (!parseSchedulePolicy(value, options.schedule)) {
+                err << "Unknown schedule policy: " << value << "\n";
+                return false;
+            }
+        } else if (arg == "--schedule-window") {
+            std::string value;
+            if (!consumeOptionWithValue(i, argc, argv, value)) {
+                err << "Missing value for --schedule-window\n";
+                return false;
+            }
+            if (!parsePositiveCount(value, options.scheduleWindow)) {
+                err << "Invalid value for --schedule-window: " << value << "\n";
+                return false;
+            }
         } else if (arg == "--exclude") {
             std::string value;
             if (!consumeOptionWithValue(i, argc, argv, value)) {
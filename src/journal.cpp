@@ -0,0 +1,173 @@
+#include "journal.hpp"
+
+#include "utils.hpp"
+
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Flush pending records at least this often so progress on a single large
+// file still reaches the journal while it is being copied.
+constexpr auto kFlushInterval = std::chrono::seconds(1);
+
+// Forces the appended records to stable storage so a crash cannot lose a
+// batch the next run would otherwise rely on.
+bool syncFile(const fs::path& p) {
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(p.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#else
+    (void)p;
+    return true;
+#endif
+}
+
+bool parseRecord(const std::string& line, std::string& relativePath, SyncJournal::Entry& entry) {
+    std::istringstream iss(line);
+    char kind = 0;
+    if (!(iss >> kind)) return false;
+    if (kind == 'D') {
+        entry.done = true;
+        if (!(iss >> entry.size >> entry.mtime)) return false;
+    } else if (kind == 'P') {
+        entry.done = false;
+        if (!(iss >> entry.size >> entry.mtime >> entry.offset >> entry.chunkLength)) return false;
+        if (entry.chunkLength > entry.offset || entry.offset > entry.size) return false;
+    } else {
+        return false;
+    }
+    // The path is everything after the single separator following the last field.
+    if (iss.get() != ' ') return false;
+    std::getline(iss, relativePath);
+    return !relativePath.empty();
+}
+
+}
+
+SyncJournal::SyncJournal(const fs::path& destinationRoot, std::size_t batchSize)
+    : journalPath(destinationRoot / kFileName),
+      batchSize(batchSize == 0 ? 1 : batchSize),
+      lastFlush(std::chrono::steady_clock::now()) {}
+
+SyncJournal::~SyncJournal() {
+    flush();
+}
+
+bool SyncJournal::load(std::ostream& err) {
+    std::error_code ec;
+    if (!fs::exists(journalPath, ec)) return true;
+
+    std::ifstream in(journalPath, std::ios::binary);
+    if (!in) {
+        err << "Failed to open journal '" << utils::toGenericString(journalPath) << "'\n";
+        return false;
+    }
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    // Only newline-terminated records are trusted; a torn final line from an
+    // interrupted append is dropped.
+    std::size_t start = 0;
+    for (std::size_t nl = contents.find('\n'); nl != std::string::npos; nl = contents.find('\n', start)) {
+        std::string line = contents.substr(start, nl - start);
+        start = nl + 1;
+        std::string rel;
+        Entry entry;
+        if (parseRecord(line, rel, entry)) {
+            entries[rel] = entry;
+        }
+    }
+    return true;
+}
+
+const SyncJournal::Entry* SyncJournal::find(const std::string& relativePath) const {
+    auto it = entries.find(relativePath);
+    return it == entries.end() ? nullptr : &it->second;
+}
+
+bool SyncJournal::recordDone(const std::string& relativePath, std::uintmax_t size, std::int64_t mtime) {
+    Entry entry;
+    entry.done = true;
+    entry.size = size;
+    entry.mtime = mtime;
+    return queue(relativePath, entry);
+}
+
+bool SyncJournal::recordProgress(const std::string& relativePath, std::uintmax_t size, std::int64_t mtime,
+                                 std::uintmax_t offset, std::uintmax_t chunkLength) {
+    Entry entry;
+    entry.size = size;
+    entry.mtime = mtime;
+    entry.offset = offset;
+    entry.chunkLength = chunkLength;
+    return queue(relativePath, entry);
+}
+
+bool SyncJournal::queue(const std::string& relativePath, const Entry& entry) {
+    // Paths with newlines cannot be represented; such files are simply not journaled.
+    if (relativePath.find('\n') != std::string::npos) return true;
+
+    entries[relativePath] = entry;
+    // Only the latest record per path matters, so repeated progress updates
+    // for the same file coalesce while they wait in the batch.
+    bool due = pending.count(relativePath) == 0 && flushDue();
+    pending[relativePath] = entry;
+    if (due || std::chrono::steady_clock::now() - lastFlush >= kFlushInterval) {
+        return flush();
+    }
+    return true;
+}
+
+bool SyncJournal::flushDue() const {
+    return pending.size() + 1 >= batchSize || std::chrono::steady_clock::now() - lastFlush >= kFlushInterval;
+}
+
+bool SyncJournal::flush() {
+    lastFlush = std::chrono::steady_clock::now();
+    if (pending.empty()) return true;
+
+    if (!stream.is_open()) {
+        std::error_code ec;
+        fs::create_directories(journalPath.parent_path(), ec);
+        stream.open(journalPath, std::ios::binary | std::ios::app);
+        if (!stream) return false;
+    }
+
+    std::ostringstream batch;
+    for (const auto& [rel, entry] : pending) {
+        if (entry.done) {
+            batch << "D " << entry.size << ' ' << entry.mtime << ' ' << rel << '\n';
+        } else {
+            batch << "P " << entry.size << ' ' << entry.mtime << ' ' << entry.offset << ' '
+                  << entry.chunkLength << ' ' << rel << '\n';
+        }
+    }
+    pending.clear();
+
+    const std::string data = batch.str();
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+    stream.flush();
+    return stream && syncFile(journalPath);
+}
+
+bool SyncJournal::remove(std::ostream& err) {
+    pending.clear();
+    entries.clear();
+    if (stream.is_open()) stream.close();
+    std::error_code ec;
+    fs::remove(journalPath, ec);
+    if (ec) {
+        err << "Failed to remove journal '" << utils::toGenericString(journalPath) << "': " << ec.message() << "\n";
+        return false;
+    }
+    return true;
+}
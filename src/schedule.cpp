@@ -0,0 +1,139 @@
+#include "schedule.hpp"
+
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace {
+
+std::uint64_t inodeNumber(const std::filesystem::path& p) {
+#if defined(__unix__) || defined(__APPLE__)
+    struct stat st;
+    if (::stat(p.c_str(), &st) == 0) {
+        return static_cast<std::uint64_t>(st.st_ino);
+    }
+#else
+    (void)p;
+#endif
+    return 0;
+}
+
+// Physical byte offset of the file's first extent, or false if the
+// filesystem does not map it (e.g. no FIEMAP support, inline or empty files).
+bool firstExtentOffset(const std::filesystem::path& p, std::uint64_t& offset) {
+#if defined(__linux__)
+    int fd = ::open(p.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    alignas(struct fiemap) char buffer[sizeof(struct fiemap) + sizeof(struct fiemap_extent)] = {};
+    auto* map = reinterpret_cast<struct fiemap*>(buffer);
+    map->fm_start = 0;
+    map->fm_length = FIEMAP_MAX_OFFSET;
+    map->fm_extent_count = 1;
+    bool ok = ::ioctl(fd, FS_IOC_FIEMAP, map) == 0 && map->fm_mapped_extents > 0;
+    if (ok) {
+        const struct fiemap_extent& extent = map->fm_extents[0];
+        ok = (extent.fe_flags & (FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DATA_INLINE)) == 0;
+        offset = extent.fe_physical;
+    }
+    ::close(fd);
+    return ok;
+#else
+    (void)p;
+    (void)offset;
+    return false;
+#endif
+}
+
+// Files whose extent is unknown fall back to inode numbers; keep them apart
+// from physical offsets instead of interleaving the two units.
+bool localityLess(const PendingCopy& a, const PendingCopy& b) {
+    if (a.hasExtent != b.hasExtent) return b.hasExtent;
+    return a.locality < b.locality;
+}
+
+}
+
+bool parseSchedulePolicy(const std::string& name, SchedulePolicy& policy) {
+    if (name == "traversal") {
+        policy = SchedulePolicy::Traversal;
+    } else if (name == "inode") {
+        policy = SchedulePolicy::Inode;
+    } else if (name == "extent") {
+        policy = SchedulePolicy::Extent;
+    } else if (name == "small-first") {
+        policy = SchedulePolicy::SmallFirst;
+    } else if (name == "large-first") {
+        policy = SchedulePolicy::LargeFirst;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* schedulePolicyName(SchedulePolicy policy) {
+    switch (policy) {
+        case SchedulePolicy::Traversal: return "traversal";
+        case SchedulePolicy::Inode: return "inode";
+        case SchedulePolicy::Extent: return "extent";
+        case SchedulePolicy::SmallFirst: return "small-first";
+        case SchedulePolicy::LargeFirst: return "large-first";
+    }
+    return "traversal";
+}
+
+std::uint64_t sourceLocality(const std::filesystem::path& p, SchedulePolicy policy, bool& hasExtent) {
+    hasExtent = false;
+    if (policy == SchedulePolicy::Traversal) return 0;
+    std::uint64_t offset = 0;
+    if (policy == SchedulePolicy::Extent && firstExtentOffset(p, offset)) {
+        hasExtent = true;
+        return offset;
+    }
+    return inodeNumber(p);
+}
+
+void orderPendingCopies(std::vector<PendingCopy>& window, SchedulePolicy policy) {
+    switch (policy) {
+        case SchedulePolicy::Traversal:
+            return;
+        case SchedulePolicy::Inode:
+        case SchedulePolicy::Extent:
+            std::stable_sort(window.begin(), window.end(), localityLess);
+            return;
+        case SchedulePolicy::SmallFirst:
+            std::stable_sort(window.begin(), window.end(), [](const PendingCopy& a, const PendingCopy& b) {
+                if (a.size != b.size) return a.size < b.size;
+                return localityLess(a, b);
+            });
+            return;
+        case SchedulePolicy::LargeFirst:
+            std::stable_sort(window.begin(), window.end(), [](const PendingCopy& a, const PendingCopy& b) {
+                if (a.size != b.size) return a.size > b.size;
+                return localityLess(a, b);
+            });
+            return;
+    }
+}
+
+void adviseWillNeed(const std::filesystem::path& p, std::uintmax_t offset, std::uintmax_t length) {
+#if defined(__linux__)
+    int fd = ::open(p.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    ::posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+    ::close(fd);
+#else
+    (void)p;
+    (void)offset;
+    (void)length;
+#endif
+}
@@ -1,22 +1,334 @@
 #include "sync.hpp"
 
+#include "journal.hpp"
+#include "schedule.hpp"
 #include "utils.hpp"
 
 #include <filesystem>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <unordered_set>
 #include <chrono>
 #include <iomanip>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace fs = std::filesystem;
 
 namespace {
 
+// Readahead for scheduled windows: how many upcoming sources to hint, and
+// how much of each to request so large files do not flood the page cache.
+constexpr std::size_t kReadaheadDepth = 4;
+constexpr std::uintmax_t kReadaheadBytes = 8 * 1024 * 1024;
+
 bool shouldCopyOrOverwrite(const fs::path& src, const fs::path& dst, bool& isOverwrite) {
     isOverwrite = fs::exists(dst);
     return utils::filesDiffer(src, dst);
 }
 
+std::int64_t mtimeTicks(fs::file_time_type t) {
+    return static_cast<std::int64_t>(t.time_since_epoch().count());
+}
+
+// True if dst exists with the given size and timestamp.
+bool destinationMatches(const fs::path& dst, std::uintmax_t size, std::int64_t mtime) {
+    std::error_code ec;
+    auto dstSize = fs::file_size(dst, ec);
+    if (ec || dstSize != size) return false;
+    auto dstTime = fs::last_write_time(dst, ec);
+    return !ec && mtimeTicks(dstTime) == mtime;
+}
+
+enum class ChunkedCopyStatus { Ok, CopyFailed, JournalFailed };
+
+#if defined(__unix__) || defined(__APPLE__)
+// Block size for comparing and for the read/write fallback of chunked copies.
+constexpr std::size_t kCopyBlockSize = 1024 * 1024;
+
+struct FileDescriptor {
+    int fd = -1;
+    ~FileDescriptor() {
+        if (fd >= 0) ::close(fd);
+    }
+};
+
+bool syncData(int fd) {
+#if defined(__APPLE__)
+    return ::fsync(fd) == 0;
+#else
+    return ::fdatasync(fd) == 0;
+#endif
+}
+
+std::string errnoMessage(int error) {
+    return std::error_code(error, std::generic_category()).message();
+}
+
+// Reads exactly length bytes at offset. Returns false on error or early EOF.
+bool preadFully(int fd, char* data, std::size_t length, std::uintmax_t offset) {
+    while (length > 0) {
+        ssize_t n = ::pread(fd, data, length, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        length -= static_cast<std::size_t>(n);
+        offset += static_cast<std::uintmax_t>(n);
+    }
+    return true;
+}
+
+// Returns the offset a journaled partial copy can continue from, or 0 if the
+// destination's last journaled chunk no longer matches the source. The
+// record is only used when the source still has the journaled size and
+// timestamp, so the same byte range of the source is the reference.
+std::uintmax_t verifiedResumeOffset(const fs::path& src, const fs::path& dst, const SyncJournal::Entry& journaled,
+                                    std::uintmax_t chunkSize) {
+    if (journaled.done || journaled.offset == 0 || journaled.chunkLength == 0) return 0;
+    if (journaled.chunkLength > chunkSize) return 0;
+
+    FileDescriptor in{::open(src.c_str(), O_RDONLY | O_CLOEXEC)};
+    FileDescriptor out{::open(dst.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (in.fd < 0 || out.fd < 0) return 0;
+
+    std::vector<char> srcBlock(kCopyBlockSize);
+    std::vector<char> dstBlock(kCopyBlockSize);
+    std::uintmax_t pos = journaled.offset - journaled.chunkLength;
+    while (pos < journaled.offset) {
+        std::size_t n = static_cast<std::size_t>(std::min<std::uintmax_t>(kCopyBlockSize, journaled.offset - pos));
+        if (!preadFully(in.fd, srcBlock.data(), n, pos) || !preadFully(out.fd, dstBlock.data(), n, pos)) return 0;
+        if (std::memcmp(srcBlock.data(), dstBlock.data(), n) != 0) return 0;
+        pos += n;
+    }
+    return journaled.offset;
+}
+
+// Copies [offset, offset + length) of in to the same range of out, using
+// copy_file_range where the kernel supports it and pread/pwrite otherwise.
+bool copyRange(int in, int out, std::uintmax_t offset, std::uintmax_t length, bool& useCopyFileRange,
+               std::vector<char>& buffer, std::string& failure) {
+    off_t inOffset = static_cast<off_t>(offset);
+    off_t outOffset = static_cast<off_t>(offset);
+    std::uintmax_t remaining = length;
+#if defined(__linux__)
+    while (remaining > 0 && useCopyFileRange) {
+        ssize_t n = ::copy_file_range(in, &inOffset, out, &outOffset, static_cast<std::size_t>(remaining), 0);
+        if (n > 0) {
+            remaining -= static_cast<std::uintmax_t>(n);
+        } else if (n == 0) {
+            failure = "source file shrank during copy";
+            return false;
+        } else if (errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP || errno == EINVAL) {
+            useCopyFileRange = false;
+        } else if (errno != EINTR) {
+            failure = errnoMessage(errno);
+            return false;
+        }
+    }
+#else
+    (void)useCopyFileRange;
+#endif
+    if (remaining > 0 && buffer.empty()) buffer.resize(kCopyBlockSize);
+    while (remaining > 0) {
+        std::size_t want = static_cast<std::size_t>(std::min<std::uintmax_t>(buffer.size(), remaining));
+        ssize_t n = ::pread(in, buffer.data(), want, inOffset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            failure = errnoMessage(errno);
+            return false;
+        }
+        if (n == 0) {
+            failure = "source file shrank during copy";
+            return false;
+        }
+        inOffset += n;
+        remaining -= static_cast<std::uintmax_t>(n);
+        for (const char* data = buffer.data(); n > 0;) {
+            ssize_t written = ::pwrite(out, data, static_cast<std::size_t>(n), outOffset);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                failure = errnoMessage(errno);
+                return false;
+            }
+            data += written;
+            n -= written;
+            outOffset += written;
+        }
+    }
+    return true;
+}
+
+// Copies src to dst one chunk at a time starting at startOffset, journaling
+// each chunk once it has been written so an interruption loses at most the
+// chunk in flight. On CopyFailed, failure holds the reason.
+ChunkedCopyStatus copyFileChunked(const fs::path& src, const fs::path& dst, const std::string& rel,
+                                  std::uintmax_t size, std::int64_t mtime, std::uintmax_t startOffset,
+                                  std::uintmax_t chunkSize, SyncJournal& journal, std::string& failure) {
+    FileDescriptor in{::open(src.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (in.fd < 0) {
+        failure = errnoMessage(errno);
+        return ChunkedCopyStatus::CopyFailed;
+    }
+    struct stat srcStat;
+    if (::fstat(in.fd, &srcStat) != 0) {
+        failure = errnoMessage(errno);
+        return ChunkedCopyStatus::CopyFailed;
+    }
+    // The partial file stays owner-writable until the copy completes so a
+    // rerun can reopen it; an existing read-only destination (e.g. a finished
+    // copy of a read-only source) is made writable the same way.
+    struct stat dstStat;
+    if (::stat(dst.c_str(), &dstStat) == 0 && (dstStat.st_mode & S_IWUSR) == 0) {
+        ::chmod(dst.c_str(), (dstStat.st_mode & 07777) | S_IWUSR);
+    }
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (startOffset > 0 ? 0 : O_TRUNC);
+    FileDescriptor out{::open(dst.c_str(), flags, S_IRUSR | S_IWUSR)};
+    if (out.fd < 0) {
+        failure = errnoMessage(errno);
+        return ChunkedCopyStatus::CopyFailed;
+    }
+
+    bool useCopyFileRange = true;
+    std::vector<char> buffer;
+    for (std::uintmax_t offset = startOffset; offset < size;) {
+        std::uintmax_t want = std::min<std::uintmax_t>(chunkSize, size - offset);
+        if (!copyRange(in.fd, out.fd, offset, want, useCopyFileRange, buffer, failure)) {
+            return ChunkedCopyStatus::CopyFailed;
+        }
+        offset += want;
+        // Progress is only recorded when the batch is about to be written, and
+        // only after the chunks it covers are on disk, so a crash cannot leave
+        // a journaled offset with unwritten data before it.
+        if (offset < size && journal.flushDue()) {
+            if (!syncData(out.fd)) {
+                failure = errnoMessage(errno);
+                return ChunkedCopyStatus::CopyFailed;
+            }
+            if (!journal.recordProgress(rel, size, mtime, offset, want) || !journal.flush()) {
+                return ChunkedCopyStatus::JournalFailed;
+            }
+        }
+    }
+    // A stale destination could be longer than the source. The source's mode
+    // is applied only now that the data is complete, as fs::copy_file does,
+    // and the data is synced before the caller records the file as done.
+    if (::ftruncate(out.fd, static_cast<off_t>(size)) != 0 || ::fchmod(out.fd, srcStat.st_mode & 07777) != 0
+        || !syncData(out.fd)) {
+        failure = errnoMessage(errno);
+        return ChunkedCopyStatus::CopyFailed;
+    }
+    int fd = out.fd;
+    out.fd = -1;
+    if (::close(fd) != 0) {
+        failure = errnoMessage(errno);
+        return ChunkedCopyStatus::CopyFailed;
+    }
+    return ChunkedCopyStatus::Ok;
+}
+#else
+// Without POSIX file APIs, large files are copied whole and cannot resume mid-file.
+std::uintmax_t verifiedResumeOffset(const fs::path&, const fs::path&, const SyncJournal::Entry&, std::uintmax_t) {
+    return 0;
+}
+
+ChunkedCopyStatus copyFileChunked(const fs::path& src, const fs::path& dst, const std::string&, std::uintmax_t,
+                                  std::int64_t, std::uintmax_t, std::uintmax_t, SyncJournal&, std::string& failure) {
+    std::error_code ec;
+    fs::copy_file(src, dst, fs::copy_options::overwrite_existing, ec);
+    if (ec) {
+        failure = ec.message();
+        return ChunkedCopyStatus::CopyFailed;
+    }
+    return ChunkedCopyStatus::Ok;
+}
+#endif
+
+// Copies (or, in dry-run, reports) one pending file and updates stats.
+// Returns false after reporting a fatal error.
+bool performCopy(const PendingCopy& copy, const CLIOptions& options, SyncJournal* journal,
+                 SyncStats& stats, std::ostream& out, std::ostream& err) {
+    // Count bytes even for dry-run to estimate throughput
+    if (copy.sizeKnown) {
+        stats.bytesTransferred += copy.size - copy.resumeOffset;
+    }
+
+    if (!utils::ensureParentDirectory(copy.destination, options.dryRun, out, err)) {
+        return false;
+    }
+    if (options.dryRun) {
+        if (copy.isOverwrite) {
+            out << "[DRY RUN] Would overwrite: " << utils::toGenericString(copy.source)
+                << " \u2192 " << utils::toGenericString(copy.destination) << "\n";
+        } else {
+            out << "[DRY RUN] Would copy: " << utils::toGenericString(copy.source)
+                << " \u2192 " << utils::toGenericString(copy.destination) << "\n";
+        }
+    } else {
+        std::error_code cpEc;
+        std::string failure;
+        if (journal && copy.sizeKnown && options.resumeChunkSize > 0 && copy.size > options.resumeChunkSize) {
+            ChunkedCopyStatus status = copyFileChunked(copy.source, copy.destination, copy.relativePath, copy.size,
+                                                       copy.mtime, copy.resumeOffset, options.resumeChunkSize,
+                                                       *journal, failure);
+            if (status == ChunkedCopyStatus::JournalFailed) {
+                err << "Failed to write journal '" << utils::toGenericString(journal->path()) << "'\n";
+                return false;
+            }
+        } else {
+            fs::copy_file(copy.source, copy.destination, fs::copy_options::overwrite_existing, cpEc);
+            if (cpEc) failure = cpEc.message();
+        }
+        if (!failure.empty()) {
+            err << "Copy failed '" << utils::toGenericString(copy.source) << "' -> '"
+                << utils::toGenericString(copy.destination) << "': " << failure << "\n";
+            return false;
+        }
+        // Attempt to preserve timestamp from source
+        auto srcTime = fs::last_write_time(copy.source, cpEc);
+        if (!cpEc) {
+            fs::last_write_time(copy.destination, srcTime, cpEc);
+        }
+        if (journal && copy.sizeKnown && !journal->recordDone(copy.relativePath, copy.size, copy.mtime)) {
+            err << "Failed to write journal '" << utils::toGenericString(journal->path()) << "'\n";
+            return false;
+        }
+    }
+    if (copy.isOverwrite) ++stats.filesOverwritten; else ++stats.filesCopied;
+    return true;
+}
+
+// Reorders a window of pending copies by the schedule policy and copies them,
+// hinting readahead for the next few sources so their reads overlap the
+// current copy. Clears the window on success.
+bool copyWindow(std::vector<PendingCopy>& window, const CLIOptions& options, SyncJournal* journal,
+                SyncStats& stats, std::ostream& out, std::ostream& err) {
+    orderPendingCopies(window, options.schedule);
+    auto hint = [&](std::size_t j) {
+        if (!options.dryRun && j < window.size()) {
+            adviseWillNeed(window[j].source, window[j].resumeOffset, kReadaheadBytes);
+        }
+    };
+    for (std::size_t j = 0; j < kReadaheadDepth; ++j) {
+        hint(j);
+    }
+    for (std::size_t i = 0; i < window.size(); ++i) {
+        hint(i + kReadaheadDepth);
+        if (!performCopy(window[i], options, journal, stats, out, err)) {
+            return false;
+        }
+    }
+    window.clear();
+    return true;
+}
+
 }
 
 int runSync(const CLIOptions& options, std::ostream& out, std::ostream& err) {
@@ -36,11 +348,28 @@ int runSync(const CLIOptions& options, std::ostream& out, std::ostream& err) {
     filter.setExcludePatterns(options.excludePatterns);
 
     SyncStats stats;
+    std::error_code ec;
+
+    // Resume journal lives in the destination; dry runs never touch it. A
+    // run without --resume may change the destination behind the journal's
+    // back, so any journal left by an interrupted resume run is discarded.
+    std::unique_ptr<SyncJournal> journal;
+    if (options.resume && !options.dryRun) {
+        journal = std::make_unique<SyncJournal>(dstRoot);
+        if (!journal->load(err)) {
+            return 1;
+        }
+    } else if (!options.dryRun && fs::exists(dstRoot / SyncJournal::kFileName, ec)) {
+        if (!SyncJournal(dstRoot).remove(err)) {
+            return 1;
+        }
+    }
 
     // Gather all included source files and perform copy/overwrite
     std::unordered_set<std::string> includedSourceFiles;
+    // Copies waiting to be reordered when a schedule policy is active.
+    std::vector<PendingCopy> window;
 
-    std::error_code ec;
     for (fs::recursive_directory_iterator it(srcRoot, ec), end; it != end; it.increment(ec)) {
         if (ec) {
             err << "Traversal error: " << ec.message() << "\n";
@@ -54,6 +383,9 @@ int runSync(const CLIOptions& options, std::ostream& out, std::ostream& err) {
             continue;
         }
         std::string rel = utils::makeRelativePOSIX(srcRoot, entry.path());
+        if (journal && rel == SyncJournal::kFileName) {
+            continue;
+        }
         if (!filter.shouldInclude(rel)) {
             ++stats.filesSkipped;
             continue;
@@ -62,46 +394,67 @@ int runSync(const CLIOptions& options, std::ostream& out, std::ostream& err) {
 
         fs::path dstPath = dstRoot / fs::path(rel);
 
+        // With a journal, files finished by an interrupted run are skipped
+        // without comparing contents again, as long as the source still has
+        // the journaled size and timestamp and the destination still carries
+        // them too (it may have been removed or lost in a crash since).
+        std::error_code sizeEc;
+        auto sz = fs::file_size(entry.path(), sizeEc);
+        std::int64_t srcMtime = 0;
+        const SyncJournal::Entry* journaled = nullptr;
+        if (journal && !sizeEc) {
+            std::error_code timeEc;
+            srcMtime = mtimeTicks(fs::last_write_time(entry.path(), timeEc));
+            journaled = timeEc ? nullptr : journal->find(rel);
+            if (journaled && (journaled->size != sz || journaled->mtime != srcMtime)) {
+                journaled = nullptr;
+            }
+            if (journaled && journaled->done && !destinationMatches(dstPath, sz, srcMtime)) {
+                journaled = nullptr;
+            }
+            if (journaled && journaled->done) {
+                ++stats.filesSkipped;
+                continue;
+            }
+        }
+
         bool isOverwrite = false;
         bool needsCopy = shouldCopyOrOverwrite(entry.path(), dstPath, isOverwrite);
         if (needsCopy) {
-            // Count bytes even for dry-run to estimate throughput
-            std::error_code sizeEc;
-            auto sz = fs::file_size(entry.path(), sizeEc);
-            if (!sizeEc) {
-                stats.bytesTransferred += sz;
-            }
-
-            if (!utils::ensureParentDirectory(dstPath, options.dryRun, out, err)) {
-                return 1;
-            }
-            if (options.dryRun) {
-                if (isOverwrite) {
-                    out << "[DRY RUN] Would overwrite: " << utils::toGenericString(entry.path())
-                        << " \u2192 " << utils::toGenericString(dstPath) << "\n";
-                } else {
-                    out << "[DRY RUN] Would copy: " << utils::toGenericString(entry.path())
-                        << " \u2192 " << utils::toGenericString(dstPath) << "\n";
+            PendingCopy copy;
+            copy.source = entry.path();
+            copy.destination = dstPath;
+            copy.relativePath = rel;
+            copy.size = sz;
+            copy.sizeKnown = !sizeEc;
+            copy.mtime = srcMtime;
+            copy.isOverwrite = isOverwrite;
+            copy.resumeOffset = journaled
+                ? verifiedResumeOffset(entry.path(), dstPath, *journaled, options.resumeChunkSize) : 0;
+            if (options.schedule == SchedulePolicy::Traversal) {
+                if (!performCopy(copy, options, journal.get(), stats, out, err)) {
+                    return 1;
                 }
             } else {
-                std::error_code cpEc;
-                fs::copy_file(entry.path(), dstPath, fs::copy_options::overwrite_existing, cpEc);
-                if (cpEc) {
-                    err << "Copy failed '" << utils::toGenericString(entry.path()) << "' -> '"
-                        << utils::toGenericString(dstPath) << "': " << cpEc.message() << "\n";
+                copy.locality = sourceLocality(copy.source, options.schedule, copy.hasExtent);
+                window.push_back(std::move(copy));
+                if (window.size() >= options.scheduleWindow
+                    && !copyWindow(window, options, journal.get(), stats, out, err)) {
                     return 1;
                 }
-                // Attempt to preserve timestamp from source
-                auto srcTime = fs::last_write_time(entry.path(), cpEc);
-                if (!cpEc) {
-                    fs::last_write_time(dstPath, srcTime, cpEc);
-                }
             }
-            if (isOverwrite) ++stats.filesOverwritten; else ++stats.filesCopied;
         } else {
+            if (journal && !sizeEc && !journal->recordDone(rel, sz, srcMtime)) {
+                err << "Failed to write journal '" << utils::toGenericString(journal->path()) << "'\n";
+                return 1;
+            }
             ++stats.filesSkipped;
         }
     }
+    // Copy whatever is left in the last, partially filled window
+    if (!window.empty() && !copyWindow(window, options, journal.get(), stats, out, err)) {
+        return 1;
+    }
 
     // Mirror mode: delete files in destination that are not present in source included set
     if (options.mirror) {
@@ -113,6 +466,7 @@ int runSync(const CLIOptions& options, std::ostream& out, std::ostream& err) {
             const fs::directory_entry& entry = *it;
             if (!entry.is_regular_file()) continue;
             std::string rel = utils::makeRelativePOSIX(dstRoot, entry.path());
+            if (rel == SyncJournal::kFileName) continue;
             // Only consider deleting files that would be included by the filter
             if (!filter.shouldInclude(rel)) continue;
             if (includedSourceFiles.find(rel) == includedSourceFiles.end()) {
@@ -131,6 +485,11 @@ int runSync(const CLIOptions& options, std::ostream& out, std::ostream& err) {
         }
     }
 
+    // Every file is accounted for, so there is nothing left to resume.
+    if (journal && !journal->remove(err)) {
+        return 1;
+    }
+
     // Summary
     if (options.dryRun) {
         out << "[SUMMARY] " << stats.filesCopied << " files would be copied, "
@@ -151,7 +510,11 @@ int runSync(const CLIOptions& options, std::ostream& out, std::ostream& err) {
         double mibps = seconds > 0.0 ? (mib / seconds) : 0.0;
         std::ios::fmtflags f(out.flags());
         out << "[TIMING] Duration: " << ms << " ms, Transferred: " << std::fixed << std::setprecision(2)
-            << mib << " MiB, Throughput: " << mibps << " MiB/s\n";
+            << mib << " MiB, Throughput: " << mibps << " MiB/s";
+        if (options.schedule != SchedulePolicy::Traversal) {
+            out << ", Schedule: " << schedulePolicyName(options.schedule);
+        }
+        out << "\n";
         out.flags(f);
     }
 
@@ -0,0 +1,196 @@
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+#include "cli.hpp"
+#include "journal.hpp"
+#include "sync.hpp"
+
+namespace fs = std::filesystem;
+
+static int failures_journal = 0;
+
+static void expectTrueJ(bool cond, const std::string& msg) {
+    if (!cond) {
+        std::cout << "[FAIL] " << msg << std::endl;
+        ++failures_journal;
+    }
+}
+
+static void writeFileJ(const fs::path& p, const std::string& content) {
+    fs::create_directories(p.parent_path());
+    std::ofstream ofs(p, std::ios::binary); ofs << content; ofs.close();
+}
+
+static std::string readFileJ(const fs::path& p) {
+    std::ifstream ifs(p, std::ios::binary);
+    std::ostringstream oss; oss << ifs.rdbuf();
+    return oss.str();
+}
+
+static std::int64_t mtimeOf(const fs::path& p) {
+    return static_cast<std::int64_t>(fs::last_write_time(p).time_since_epoch().count());
+}
+
+int run_test_journal() {
+    std::cout << "[RUN] journal" << std::endl;
+
+    fs::path base = fs::temp_directory_path() / ("synccli_journal_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::path src = base / "src";
+    fs::path dst = base / "dst";
+    fs::create_directories(dst);
+
+    // Records survive a reload; a torn trailing record is ignored.
+    {
+        {
+            SyncJournal j(dst);
+            j.recordDone("a b/done.txt", 5, 42);
+            j.recordProgress("big.bin", 100, 7, 32, 16);
+            expectTrueJ(j.flush(), "journal flush");
+        }
+        {
+            std::ofstream torn(dst / SyncJournal::kFileName, std::ios::binary | std::ios::app);
+            torn << "D 5 42 partial";
+        }
+        SyncJournal j(dst);
+        expectTrueJ(j.load(std::cerr), "journal load");
+        const SyncJournal::Entry* done = j.find("a b/done.txt");
+        expectTrueJ(done && done->done && done->size == 5 && done->mtime == 42, "done record round-trips");
+        const SyncJournal::Entry* progress = j.find("big.bin");
+        expectTrueJ(progress && !progress->done && progress->offset == 32 && progress->chunkLength == 16,
+                    "progress record round-trips");
+        expectTrueJ(j.find("partial") == nullptr, "torn record ignored");
+        j.remove(std::cerr);
+        expectTrueJ(!fs::exists(dst / SyncJournal::kFileName), "journal removed");
+    }
+
+    const std::string payload = "0123456789abcdefghijklmnopqrstuvwxyzABCD";
+    writeFileJ(src / "big.bin", payload);
+    writeFileJ(src / "done.txt", "finished");
+
+    // A partial copy whose last journaled chunk matches the source continues
+    // from the journaled offset (earlier bytes are not rewritten), and a
+    // journaled finished file whose destination still has the journaled size
+    // and timestamp is not compared or copied again.
+    {
+        writeFileJ(dst / "big.bin", std::string(8, 'X') + payload.substr(8, 8));
+        writeFileJ(dst / "done.txt", "FINISHED");
+        fs::last_write_time(dst / "done.txt", fs::last_write_time(src / "done.txt"));
+        {
+            SyncJournal j(dst);
+            j.recordProgress("big.bin", payload.size(), mtimeOf(src / "big.bin"), 16, 8);
+            j.recordDone("done.txt", 8, mtimeOf(src / "done.txt"));
+        }
+
+        CLIOptions opts;
+        opts.sourcePath = src;
+        opts.destinationPath = dst;
+        opts.resume = true;
+        opts.resumeChunkSize = 8;
+        int rc = runSync(opts, std::cout, std::cerr);
+        expectTrueJ(rc == 0, "resume sync rc==0");
+        expectTrueJ(readFileJ(dst / "big.bin") == std::string(8, 'X') + payload.substr(8), "partial file resumed at offset");
+        expectTrueJ(readFileJ(dst / "done.txt") == "FINISHED", "journaled file skipped");
+        expectTrueJ(!fs::exists(dst / SyncJournal::kFileName), "journal removed after success");
+    }
+
+    // A partial copy whose last chunk no longer matches the source starts
+    // over, and a journaled finished file missing from the destination is
+    // copied again.
+    {
+        writeFileJ(dst / "big.bin", std::string(16, 'Y'));
+        fs::remove(dst / "done.txt");
+        {
+            SyncJournal j(dst);
+            j.recordProgress("big.bin", payload.size(), mtimeOf(src / "big.bin"), 16, 8);
+            j.recordDone("done.txt", 8, mtimeOf(src / "done.txt"));
+        }
+
+        CLIOptions opts;
+        opts.sourcePath = src;
+        opts.destinationPath = dst;
+        opts.resume = true;
+        opts.resumeChunkSize = 8;
+        int rc = runSync(opts, std::cout, std::cerr);
+        expectTrueJ(rc == 0, "restart sync rc==0");
+        expectTrueJ(readFileJ(dst / "big.bin") == payload, "unverified partial copied from scratch");
+        expectTrueJ(readFileJ(dst / "done.txt") == "finished", "journaled file missing from destination recopied");
+    }
+
+    // A record claiming a chunk larger than the chunk size is not trusted.
+    {
+        writeFileJ(dst / "big.bin", std::string(8, 'Z') + payload.substr(8, 24));
+        {
+            SyncJournal j(dst);
+            j.recordProgress("big.bin", payload.size(), mtimeOf(src / "big.bin"), 32, 24);
+        }
+
+        CLIOptions opts;
+        opts.sourcePath = src;
+        opts.destinationPath = dst;
+        opts.resume = true;
+        opts.resumeChunkSize = 8;
+        int rc = runSync(opts, std::cout, std::cerr);
+        expectTrueJ(rc == 0, "oversized chunk sync rc==0");
+        expectTrueJ(readFileJ(dst / "big.bin") == payload, "oversized journaled chunk copied from scratch");
+    }
+
+    // Chunked copies end with the source's mode, whether the destination is
+    // new, an existing file with other permissions, or a resumed partial.
+    {
+        writeFileJ(src / "mode.bin", payload);
+        fs::permissions(src / "mode.bin", fs::perms::owner_read | fs::perms::owner_write | fs::perms::group_read);
+        writeFileJ(dst / "mode.bin", "old");
+        fs::permissions(dst / "mode.bin", fs::perms::owner_read | fs::perms::owner_write);
+        writeFileJ(src / "ro.bin", payload);
+        fs::permissions(src / "ro.bin", fs::perms::owner_read | fs::perms::group_read | fs::perms::others_read);
+        writeFileJ(dst / "ro.bin", payload.substr(0, 16));
+        fs::permissions(dst / "ro.bin", fs::perms::owner_read);
+        {
+            SyncJournal j(dst);
+            j.recordProgress("ro.bin", payload.size(), mtimeOf(src / "ro.bin"), 16, 8);
+        }
+
+        CLIOptions opts;
+        opts.sourcePath = src;
+        opts.destinationPath = dst;
+        opts.resume = true;
+        opts.resumeChunkSize = 8;
+        int rc = runSync(opts, std::cout, std::cerr);
+        expectTrueJ(rc == 0, "mode sync rc==0");
+        expectTrueJ(fs::status(dst / "mode.bin").permissions() == fs::status(src / "mode.bin").permissions(),
+                    "source mode applied to existing destination");
+        expectTrueJ(readFileJ(dst / "ro.bin") == payload, "read-only partial resumed");
+        expectTrueJ(fs::status(dst / "ro.bin").permissions() == fs::status(src / "ro.bin").permissions(),
+                    "read-only source mode applied after resume");
+        fs::permissions(src / "ro.bin", fs::perms::owner_write, fs::perm_options::add);
+        fs::permissions(dst / "ro.bin", fs::perms::owner_write, fs::perm_options::add);
+    }
+
+    // A run without --resume discards a journal left by an interrupted resume
+    // run, since it may change the destination behind the journal's back.
+    {
+        {
+            SyncJournal j(dst);
+            j.recordDone("done.txt", 8, mtimeOf(src / "done.txt"));
+        }
+        CLIOptions opts;
+        opts.sourcePath = src;
+        opts.destinationPath = dst;
+        opts.dryRun = true;
+        runSync(opts, std::cout, std::cerr);
+        expectTrueJ(fs::exists(dst / SyncJournal::kFileName), "dry run keeps journal");
+        opts.dryRun = false;
+        int rc = runSync(opts, std::cout, std::cerr);
+        expectTrueJ(rc == 0, "plain sync rc==0");
+        expectTrueJ(!fs::exists(dst / SyncJournal::kFileName), "plain sync removes stale journal");
+    }
+
+    std::error_code ec;
+    fs::remove_all(base, ec);
+
+    std::cout << "[DONE] journal" << std::endl;
+    return failures_journal;
+}
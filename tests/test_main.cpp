@@ -3,12 +3,16 @@
 int run_test_utils();
 int run_test_filters();
 int run_test_sync();
+int run_test_journal();
+int run_test_schedule();
 
 int main() {
     int failures = 0;
     failures += run_test_utils();
     failures += run_test_filters();
     failures += run_test_sync();
+    failures += run_test_journal();
+    failures += run_test_schedule();
 
     if (failures == 0) {
         std::cout << "All tests passed" << std::endl;
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+#include "cli.hpp"
+#include "schedule.hpp"
+#include "sync.hpp"
+
+namespace fs = std::filesystem;
+
+static int failures_schedule = 0;
+
+static void expectTrueSch(bool cond, const std::string& msg) {
+    if (!cond) {
+        std::cout << "[FAIL] " << msg << std::endl;
+        ++failures_schedule;
+    }
+}
+
+static PendingCopy pending(const std::string& rel, std::uintmax_t size, std::uint64_t locality, bool hasExtent = false) {
+    PendingCopy copy;
+    copy.relativePath = rel;
+    copy.size = size;
+    copy.locality = locality;
+    copy.hasExtent = hasExtent;
+    return copy;
+}
+
+static std::string order(const std::vector<PendingCopy>& window) {
+    std::string names;
+    for (const auto& c : window) names += c.relativePath;
+    return names;
+}
+
+int run_test_schedule() {
+    std::cout << "[RUN] schedule" << std::endl;
+
+    SchedulePolicy policy = SchedulePolicy::Traversal;
+    expectTrueSch(parseSchedulePolicy("small-first", policy) && policy == SchedulePolicy::SmallFirst, "parse small-first");
+    expectTrueSch(parseSchedulePolicy("extent", policy) && policy == SchedulePolicy::Extent, "parse extent");
+    expectTrueSch(!parseSchedulePolicy("random", policy), "reject unknown policy");
+    expectTrueSch(std::string(schedulePolicyName(SchedulePolicy::LargeFirst)) == "large-first", "policy name");
+
+    const std::vector<PendingCopy> window = {
+        pending("a", 30, 3), pending("b", 10, 2), pending("c", 20, 1), pending("d", 10, 0),
+    };
+    {
+        auto w = window;
+        orderPendingCopies(w, SchedulePolicy::Traversal);
+        expectTrueSch(order(w) == "abcd", "traversal keeps order");
+    }
+    {
+        auto w = window;
+        orderPendingCopies(w, SchedulePolicy::Inode);
+        expectTrueSch(order(w) == "dcba", "inode orders by locality");
+    }
+    {
+        auto w = window;
+        orderPendingCopies(w, SchedulePolicy::SmallFirst);
+        expectTrueSch(order(w) == "dbca", "small-first with locality tie-break");
+    }
+    {
+        auto w = window;
+        orderPendingCopies(w, SchedulePolicy::LargeFirst);
+        expectTrueSch(order(w) == "acdb", "large-first with locality tie-break");
+    }
+
+    // Extent offsets and inode fallbacks are ordered as separate groups.
+    {
+        std::vector<PendingCopy> w = {
+            pending("a", 1, 4096000, true), pending("b", 1, 12), pending("c", 1, 8192, true), pending("d", 1, 7),
+        };
+        orderPendingCopies(w, SchedulePolicy::Extent);
+        expectTrueSch(order(w) == "dbca", "extent keeps inode fallbacks apart from physical offsets");
+    }
+
+    fs::path base = fs::temp_directory_path() / ("synccli_schedule_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::create_directories(base);
+
+    // Inode keys never claim an extent; an empty file has no extent, so the
+    // extent policy falls back to the same inode key.
+    {
+        fs::path empty = base / "empty";
+        fs::path data = base / "data";
+        std::ofstream(empty).close();
+        std::ofstream(data) << std::string(64 * 1024, 'x');
+        bool hasExtent = true;
+        std::uint64_t inodeKey = sourceLocality(empty, SchedulePolicy::Inode, hasExtent);
+        expectTrueSch(!hasExtent, "inode policy reports no extent");
+        std::uint64_t extentKey = sourceLocality(empty, SchedulePolicy::Extent, hasExtent);
+        expectTrueSch(!hasExtent && extentKey == inodeKey, "empty file falls back to inode");
+        std::uint64_t dataInode = sourceLocality(data, SchedulePolicy::Inode, hasExtent);
+        std::uint64_t dataKey = sourceLocality(data, SchedulePolicy::Extent, hasExtent);
+        expectTrueSch(hasExtent || dataKey == dataInode, "extent key is a physical offset or the inode fallback");
+        sourceLocality(data, SchedulePolicy::Traversal, hasExtent);
+        expectTrueSch(!hasExtent, "traversal computes no locality");
+    }
+
+    // Every policy copies the full tree, including a partial final window.
+    fs::path src = base / "src";
+    for (int i = 0; i < 5; ++i) {
+        fs::create_directories(src / "d");
+        std::ofstream(src / "d" / ("f" + std::to_string(i) + ".txt")) << std::string(static_cast<std::size_t>(i + 1), 'x');
+    }
+    for (const char* name : {"traversal", "inode", "extent", "small-first", "large-first"}) {
+        CLIOptions opts;
+        opts.sourcePath = src;
+        opts.destinationPath = base / name;
+        parseSchedulePolicy(name, opts.schedule);
+        opts.scheduleWindow = 2;
+        opts.showTime = true;
+        std::ostringstream out;
+        int rc = runSync(opts, out, std::cerr);
+        expectTrueSch(rc == 0, std::string(name) + " sync rc==0");
+        bool complete = true;
+        for (int i = 0; i < 5; ++i) {
+            fs::path copied = base / name / "d" / ("f" + std::to_string(i) + ".txt");
+            complete = complete && fs::exists(copied) && fs::file_size(copied) == static_cast<std::uintmax_t>(i + 1);
+        }
+        expectTrueSch(complete, std::string(name) + " copies every file");
+        bool named = out.str().find(std::string("Schedule: ") + schedulePolicyName(opts.schedule)) != std::string::npos;
+        expectTrueSch(named == (opts.schedule != SchedulePolicy::Traversal), std::string(name) + " timing names the policy");
+    }
+
+    std::error_code ec;
+    fs::remove_all(base, ec);
+
+    std::cout << "[DONE] schedule" << std::endl;
+    return failures_schedule;
+}